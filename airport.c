@@ -2,47 +2,108 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
 #include <sys/msg.h>
+#include <sys/shm.h>
 #include <stdbool.h>
+#include <limits.h>
+
+#include "ipc.h"
+#include "flight_table.h"
+#include "metrics.h"
+#include "occupancy.h"
 
 #define MAX_RUNWAYS 10
 #define BACKUP_RUNWAY_LOAD_CAPACITY 15000
 #define ATC_RCV_MSG_TYPE 4
 #define ATC_SND_MSG_TYPE 5
-
-// Structure to store plane details
-typedef struct {
-    int plane_id;
-    int departure_airport;
-    int arrival_airport;
-    double total_weight;
-    int plane_type; // 0 for cargo, 1 for passenger
-    int num_passengers; // Relevant only for passenger planes
-} PlaneDetails;
-
-// Structure for message sent between processes
-typedef struct {
-    long mtype; // message type
-    PlaneDetails details; // plane details
-} Message;
+#define METRICS_SOCKET_NAME_FMT "atc_airport_%d.sock"
 
 // Structure to represent a runway
 typedef struct {
     int runway_id;
     double load_capacity;
     bool is_available;
+    unsigned long available_at_usec; // closed for the separation gap until then
     pthread_mutex_t lock;
 } Runway;
 
 // Structure to hold thread function arguments
 typedef struct {
-    Message *msg;
+    FlightTable *flights;
+    FlightHandle handle;
     Runway *runways;
     int num_runways;
+    const OccupancyModel *occupancy;
     int airport_num;
     int msgqid;
 } ThreadArgs;
 
+// Structure to hold the counters exported on the metrics socket.
+// Only the handler threads write them (relaxed atomic adds, no locks) and
+// the exporter thread only reads them, so a scrape never blocks a runway.
+typedef struct {
+    atomic_ulong departures_handled;
+    atomic_ulong arrivals_handled;
+    atomic_ulong backup_runway_fallbacks;
+    atomic_ulong messages_received;
+    atomic_ulong messages_sent;
+    atomic_ulong runway_busy_usec[MAX_RUNWAYS + 1]; // +1 for backup runway
+} AirportMetrics;
+
+// Structure to hold the context passed to write_metrics
+typedef struct {
+    int airport_num;
+    int num_runways;
+    int msgqid;
+} MetricsArgs;
+
+static AirportMetrics metrics;
+
+// Function to get a monotonic timestamp in microseconds
+static unsigned long monotonic_usec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long) ts.tv_sec * 1000000UL + ts.tv_nsec / 1000;
+}
+
+// Function to write all metrics in Prometheus text format
+void write_metrics(FILE *out, void *context) {
+    MetricsArgs *metricsArgs = (MetricsArgs*) context;
+    int airport_num = metricsArgs->airport_num;
+    int num_runways = metricsArgs->num_runways;
+    struct msqid_ds queue_stats;
+    unsigned long queue_depth = 0;
+    if (msgctl(metricsArgs->msgqid, IPC_STAT, &queue_stats) == 0) {
+        queue_depth = queue_stats.msg_qnum;
+    }
+
+    fprintf(out, "# TYPE atc_airport_departures_total counter\n");
+    fprintf(out, "atc_airport_departures_total{airport=\"%d\"} %lu\n", airport_num, metrics_read(&metrics.departures_handled));
+    fprintf(out, "# TYPE atc_airport_arrivals_total counter\n");
+    fprintf(out, "atc_airport_arrivals_total{airport=\"%d\"} %lu\n", airport_num, metrics_read(&metrics.arrivals_handled));
+    fprintf(out, "# TYPE atc_airport_backup_runway_fallbacks_total counter\n");
+    fprintf(out, "atc_airport_backup_runway_fallbacks_total{airport=\"%d\"} %lu\n", airport_num, metrics_read(&metrics.backup_runway_fallbacks));
+    fprintf(out, "# TYPE atc_airport_messages_received_total counter\n");
+    fprintf(out, "atc_airport_messages_received_total{airport=\"%d\"} %lu\n", airport_num, metrics_read(&metrics.messages_received));
+    fprintf(out, "# TYPE atc_airport_messages_sent_total counter\n");
+    fprintf(out, "atc_airport_messages_sent_total{airport=\"%d\"} %lu\n", airport_num, metrics_read(&metrics.messages_sent));
+
+    // Runway numbers match the ones printed to the console; the last one is the backup runway
+    fprintf(out, "# TYPE atc_airport_runway_busy_seconds_total counter\n");
+    for (int i = 0; i <= num_runways; i++) {
+        fprintf(out, "atc_airport_runway_busy_seconds_total{airport=\"%d\",runway=\"%d\",backup=\"%s\"} %.6f\n",
+                airport_num, i + 1, i == num_runways ? "true" : "false", metrics_read(&metrics.runway_busy_usec[i]) / 1e6);
+    }
+
+    // All processes share one queue, so this is the global depth, not this airport's backlog
+    fprintf(out, "# HELP atc_message_queue_depth Messages waiting in the queue shared by the ATC, airports and planes\n");
+    fprintf(out, "# TYPE atc_message_queue_depth gauge\n");
+    fprintf(out, "atc_message_queue_depth %lu\n", queue_depth);
+}
+
 // Function to initialize the airport
 void initialize_airport(int airport_num, int num_runways, Runway *runways) {
     // Prompt the user to enter the load capacity for each runway
@@ -50,53 +111,87 @@ void initialize_airport(int airport_num, int num_runways, Runway *runways) {
     for (int i = 0; i < num_runways; i++) {
         scanf("%lf", &runways[i].load_capacity);
         
+        runways[i].runway_id = i + 1;
         runways[i].is_available = true;
+        runways[i].available_at_usec = 0;
         pthread_mutex_init(&runways[i].lock, NULL);
     }
+
+    // Initialize the backup runway used when no runway fits
+    runways[num_runways].runway_id = num_runways + 1;
+    runways[num_runways].load_capacity = BACKUP_RUNWAY_LOAD_CAPACITY;
+    runways[num_runways].is_available = true;
+    runways[num_runways].available_at_usec = 0;
+    pthread_mutex_init(&runways[num_runways].lock, NULL);
 }
 
-// Function to select a runway based on best-fit logic
+// Function to select a runway based on best-fit logic. Among the runways that
+// can carry the load, the one that reopens first after its separation gap wins,
+// ties go to the best fit, and the backup runway is only used when it reopens
+// strictly sooner. Returns -1 only if no runway, backup included, can carry the load.
 int select_runway(Runway *runways, int num_runways, double total_weight) {
-    int best_fit_runway = -1;
+    int selected_runway = -1;
+    unsigned long earliest_open = ULONG_MAX;
     double min_difference = __INT_MAX__;
+    unsigned long now = monotonic_usec();
 
-    // Find the runway with load capacity closest to the total weight
-    for (int i = 0; i < num_runways; ++i) {
+    for (int i = 0; i <= num_runways; ++i) {
+        double difference = runways[i].load_capacity - total_weight;
+        if (difference < 0) {
+            continue;
+        }
+
+        // A runway in use reopens at an unknown time, so it comes last
         pthread_mutex_lock(&runways[i].lock);
+        unsigned long open_at = ULONG_MAX;
         if (runways[i].is_available) {
-            double difference = runways[i].load_capacity - total_weight;
-            if (difference >= 0 && difference < min_difference) {
-                min_difference = difference;
-                best_fit_runway = i;
-            }
+            open_at = runways[i].available_at_usec > now ? runways[i].available_at_usec : now;
         }
         pthread_mutex_unlock(&runways[i].lock);
+
+        if (selected_runway == -1 || open_at < earliest_open
+            || (open_at == earliest_open && i < num_runways && difference < min_difference)) {
+            earliest_open = open_at;
+            min_difference = difference;
+            selected_runway = i;
+        }
+    }
+
+    if (selected_runway == num_runways) {
+        metrics_add(&metrics.backup_runway_fallbacks, 1);
     }
 
-    // If no runway found, use backup runway
-    if (best_fit_runway == -1) {
-        return num_runways;
+    return selected_runway;
+}
+
+// Function to sleep for a fractional number of seconds
+void sleep_seconds(double duration) {
+    if (duration <= 0) {
+        return;
     }
 
-    return best_fit_runway;
+    struct timespec ts;
+    ts.tv_sec = (time_t) duration;
+    ts.tv_nsec = (long) ((duration - ts.tv_sec) * 1e9);
+    nanosleep(&ts, NULL);
 }
 
 // Function to simulate boarding/loading process
 void simulate_boarding_loading(double duration) {
-    printf("Boarding/loading for %.0f seconds...\n", duration);
-    sleep(duration);
+    printf("Boarding/loading for %.1f seconds...\n", duration);
+    sleep_seconds(duration);
 }
 
 // Function to simulate deboarding/unloading process
 void simulate_deboarding_unloading(double duration) {
-    printf("Deboarding/unloading for %.0f seconds...\n", duration);
-    sleep(duration);
+    printf("Deboarding/unloading for %.1f seconds...\n", duration);
+    sleep_seconds(duration);
 }
 
 // Function to create a single message queue for communication
 int create_message_queue() {
     // Generate a unique key for the message queue
-    key_t key = ftok(".", 'g');
+    key_t key = get_ipc_key('g');
 
     // Create a message queue with read-write permissions
     int msgqid = msgget(key, 0666 | IPC_CREAT);
@@ -104,20 +199,62 @@ int create_message_queue() {
     return msgqid;
 }
 
+// Function to attach to the flight table owned by the air traffic controller
+FlightTable* attach_flight_table() {
+    // Generate a unique key for the shared memory segment
+    key_t key = get_ipc_key(FLIGHT_TABLE_PROJ_ID);
+
+    int shmid = shmget(key, sizeof(FlightTable), 0666 | IPC_CREAT);
+    if (shmid == -1) {
+        perror("shmget");
+        exit(EXIT_FAILURE);
+    }
+
+    FlightTable *flights = shmat(shmid, NULL, SHM_RDONLY);
+    if (flights == (void*) -1) {
+        perror("shmat");
+        exit(EXIT_FAILURE);
+    }
+
+    return flights;
+}
+
+// Function to report a flight's new state back to the air traffic controller
+void send_flight_message(int msgqid, long mtype, FlightHandle handle, FlightState state) {
+    FlightMessage msg;
+    msg.mtype = mtype;
+    msg.handle = handle;
+    msg.state = state;
+
+    msgsnd(msgqid, &msg, sizeof(FlightMessage) - sizeof(long), 0);
+}
+
 // Function to handle plane departure
 void* handle_departure(void *args) {
     ThreadArgs *threadArgs = (ThreadArgs*) args;
-    Message *msg = threadArgs->msg;
-    PlaneDetails plane = msg->details;
+    FlightTable *flights = threadArgs->flights;
+    FlightHandle handle = threadArgs->handle;
+    int slot = handle & FLIGHT_SLOT_MASK;
     Runway *runways = threadArgs->runways;
     int num_runways = threadArgs->num_runways;
+    const OccupancyModel *occupancy = threadArgs->occupancy;
     int msgqid = threadArgs->msgqid;
     int airport_num = threadArgs->airport_num;
 
+    // Copy the flight out of its slot; the ATC frees the slot for the next
+    // flight as soon as it gets our reply, so it is not read after that
+    int plane_id = flights->plane_id[slot];
+    int departure_airport = flights->departure_airport[slot];
+    double total_weight = flights->total_weight[slot];
+    int plane_type = flights->plane_type[slot];
+    int num_passengers = flights->num_passengers[slot];
+
     // Find the best-fit runway for departure
-    int selected_runway = select_runway(runways, num_runways, plane.total_weight);
+    int selected_runway = select_runway(runways, num_runways, total_weight);
     if (selected_runway == -1) {
-        printf("No runway available for plane %d departure from Airport %d\n", plane.plane_id, plane.departure_airport);
+        printf("No runway can carry plane %d for departure from Airport %d\n", plane_id, departure_airport);
+        send_flight_message(msgqid, airport_num+30, handle, FLIGHT_REJECTED);
+        metrics_add(&metrics.messages_sent, 1);
         return NULL;
     }
 
@@ -125,23 +262,34 @@ void* handle_departure(void *args) {
     pthread_mutex_lock(&runways[selected_runway].lock);
     runways[selected_runway].is_available = false;
 
+    // Wait out the rest of the runway's separation gap
+    unsigned long busy_start = monotonic_usec();
+    if (runways[selected_runway].available_at_usec > busy_start) {
+        sleep_seconds((runways[selected_runway].available_at_usec - busy_start) / 1e6);
+        busy_start = monotonic_usec();
+    }
+
     // Simulate boarding/loading process
-    simulate_boarding_loading(3);
+    simulate_boarding_loading(turnaround_time(occupancy, plane_type, num_passengers, total_weight));
 
     // Simulate takeoff process
-    sleep(2);
+    sleep_seconds(runway_roll_time(occupancy, total_weight));
 
     // Send message to air traffic controller
-    Message departure_msg;
     //departure_msg.mtype = ATC_SND_MSG_TYPE;
-    departure_msg.mtype = airport_num+30;
-    departure_msg.details = plane;
-    msgsnd(msgqid, &departure_msg, sizeof(Message) - sizeof(long), 0);
+    send_flight_message(msgqid, airport_num+30, handle, FLIGHT_DEPARTED);
+    metrics_add(&metrics.messages_sent, 1);
 
     // Print departure message
-    printf("Plane %d has completed boarding/loading and taken off from Runway No. %d of Airport No. %d\n", plane.plane_id, selected_runway + 1, plane.departure_airport);
-
-    // Unlock the selected runway
+    printf("Plane %d has completed boarding/loading and taken off from Runway No. %d of Airport No. %d\n", plane_id, selected_runway + 1, departure_airport);
+
+    // Unlock the runway; it only reopens for selection after the separation gap,
+    // so the airport can serve its other runways in the meantime
+    unsigned long gap_usec = (unsigned long) (occupancy->separation_gap * 1e6);
+    unsigned long released = monotonic_usec();
+    metrics_add(&metrics.runway_busy_usec[selected_runway], released - busy_start + gap_usec);
+    metrics_add(&metrics.departures_handled, 1);
+    runways[selected_runway].available_at_usec = released + gap_usec;
     runways[selected_runway].is_available = true;
     pthread_mutex_unlock(&runways[selected_runway].lock);
 
@@ -151,17 +299,29 @@ void* handle_departure(void *args) {
 // Function to handle plane arrival
 void* handle_arrival(void *args) {
     ThreadArgs *threadArgs = (ThreadArgs*) args;
-    Message *msg = threadArgs->msg;
-    PlaneDetails plane = msg->details;
+    FlightTable *flights = threadArgs->flights;
+    FlightHandle handle = threadArgs->handle;
+    int slot = handle & FLIGHT_SLOT_MASK;
     Runway *runways = threadArgs->runways;
     int num_runways = threadArgs->num_runways;
+    const OccupancyModel *occupancy = threadArgs->occupancy;
     int msgqid = threadArgs->msgqid;
     int airport_num = threadArgs->airport_num;
 
+    // Copy the flight out of its slot; the ATC frees the slot for the next
+    // flight as soon as it gets our reply, so it is not read after that
+    int plane_id = flights->plane_id[slot];
+    int arrival_airport = flights->arrival_airport[slot];
+    double total_weight = flights->total_weight[slot];
+    int plane_type = flights->plane_type[slot];
+    int num_passengers = flights->num_passengers[slot];
+
     // Find the best-fit runway for arrival
-    int selected_runway = select_runway(runways, num_runways, plane.total_weight);
+    int selected_runway = select_runway(runways, num_runways, total_weight);
     if (selected_runway == -1) {
-        printf("No runway available for plane %d arrival at Airport %d\n", plane.plane_id, plane.arrival_airport);
+        printf("No runway can carry plane %d for arrival at Airport %d\n", plane_id, arrival_airport);
+        send_flight_message(msgqid, airport_num+30, handle, FLIGHT_REJECTED);
+        metrics_add(&metrics.messages_sent, 1);
         return NULL;
     }
 
@@ -169,23 +329,34 @@ void* handle_arrival(void *args) {
     pthread_mutex_lock(&runways[selected_runway].lock);
     runways[selected_runway].is_available = false;
 
+    // Wait out the rest of the runway's separation gap
+    unsigned long busy_start = monotonic_usec();
+    if (runways[selected_runway].available_at_usec > busy_start) {
+        sleep_seconds((runways[selected_runway].available_at_usec - busy_start) / 1e6);
+        busy_start = monotonic_usec();
+    }
+
     // Simulate landing process
-    sleep(2);
+    sleep_seconds(runway_roll_time(occupancy, total_weight));
 
     // Simulate deboarding/unloading process
-    simulate_deboarding_unloading(3);
+    simulate_deboarding_unloading(turnaround_time(occupancy, plane_type, num_passengers, total_weight));
 
     // Send message to air traffic controller
-    Message arrival_msg;
     //arrival_msg.mtype = ATC_SND_MSG_TYPE;
-    arrival_msg.mtype = airport_num+30;
-    arrival_msg.details = plane;
-    msgsnd(msgqid, &arrival_msg, sizeof(Message) - sizeof(long), 0);
+    send_flight_message(msgqid, airport_num+30, handle, FLIGHT_ARRIVED);
+    metrics_add(&metrics.messages_sent, 1);
 
     // Print arrival message
-    printf("Plane %d has landed on Runway No. %d of Airport No. %d and has completed deboarding/unloading\n", plane.plane_id, selected_runway + 1, plane.arrival_airport);
-
-    // Unlock the selected runway
+    printf("Plane %d has landed on Runway No. %d of Airport No. %d and has completed deboarding/unloading\n", plane_id, selected_runway + 1, arrival_airport);
+
+    // Unlock the runway; it only reopens for selection after the separation gap,
+    // so the airport can serve its other runways in the meantime
+    unsigned long gap_usec = (unsigned long) (occupancy->separation_gap * 1e6);
+    unsigned long released = monotonic_usec();
+    metrics_add(&metrics.runway_busy_usec[selected_runway], released - busy_start + gap_usec);
+    metrics_add(&metrics.arrivals_handled, 1);
+    runways[selected_runway].available_at_usec = released + gap_usec;
     runways[selected_runway].is_available = true;
     pthread_mutex_unlock(&runways[selected_runway].lock);
 
@@ -204,49 +375,89 @@ int main() {
     printf("Enter number of Runways: ");
     scanf("%d", &num_runways);
 
+    // Validate the number of runways
+    while (num_runways < 1 || num_runways > MAX_RUNWAYS) {
+        printf("Invalid input. Please enter a number between 1 and %d: ", MAX_RUNWAYS);
+        scanf("%d", &num_runways);
+    }
+
     // Initialize the airport
     Runway runways[num_runways + 1]; 
      // +1 for backup runway
     initialize_airport(airport_num, num_runways, runways);
 
+    // Set up how long each plane occupies a runway
+    OccupancyModel occupancy;
+    initialize_occupancy_model(&occupancy);
+
     // Create a single message queue for communication
     int msgqid = create_message_queue();
 
+    // Attach to the flight table shared with the air traffic controller
+    FlightTable *flights = attach_flight_table();
+
+    // Start the metrics exporter so operators can scrape the airport
+    MetricsArgs metricsArgs;
+    metricsArgs.airport_num = airport_num;
+    metricsArgs.num_runways = num_runways;
+    metricsArgs.msgqid = msgqid;
+    MetricsExporter exporter;
+    snprintf(exporter.socket_name, sizeof(exporter.socket_name), METRICS_SOCKET_NAME_FMT, airport_num);
+    exporter.write_metrics = write_metrics;
+    exporter.context = &metricsArgs;
+    start_metrics_exporter(&exporter);
+
     // Main loop to handle incoming messages
     while (true) {
         // Declare a buffer for receiving messages
-        Message msg;
+        FlightMessage msg;
 
-        // Receive a message from the air traffic controller
+        // Receive a flight handle from the air traffic controller
         //msgrcv(msgqid, &msg, sizeof(Message) - sizeof(long), ATC_RCV_MSG_TYPE, 0);
-        msgrcv(msgqid, &msg, sizeof(Message) - sizeof(long), airport_num + 20, 0);
+        msgrcv(msgqid, &msg, sizeof(FlightMessage) - sizeof(long), airport_num + 20, 0);
+        metrics_add(&metrics.messages_received, 1);
+
+        // Reject handles to slots that have since been reused or moved on,
+        // so the ATC waiting for this airport is not left blocked
+        int slot = msg.handle & FLIGHT_SLOT_MASK;
+        if (slot >= MAX_FLIGHTS || flights->generation[slot] != msg.handle >> FLIGHT_SLOT_BITS
+            || flights->state[slot] != msg.state) {
+            printf("Rejecting stale flight handle %u\n", msg.handle);
+            send_flight_message(msgqid, airport_num+30, msg.handle, FLIGHT_REJECTED);
+            metrics_add(&metrics.messages_sent, 1);
+            continue;
+        }
 
         // Create a new thread to handle the arrival or departure of the plane
         
 
-        if (msg.details.arrival_airport == airport_num) {
+        if (msg.state == FLIGHT_ARRIVING) {
             pthread_t tid;
         pthread_attr_t attr;
         pthread_attr_init(&attr); // Initialize thread attributes
          
         ThreadArgs threadArgs;
-        threadArgs.msg = &msg;
+        threadArgs.flights = flights;
+        threadArgs.handle = msg.handle;
         threadArgs.runways = runways;
         threadArgs.num_runways = num_runways;
+        threadArgs.occupancy = &occupancy;
         threadArgs.msgqid = msgqid;
         threadArgs.airport_num = airport_num;
             pthread_create(&tid, &attr, handle_arrival, (void*) &threadArgs);
             // Wait for the thread to finish before proceeding to the next iteration
             pthread_join(tid, NULL);
-        } else if (msg.details.departure_airport == airport_num) {
+        } else if (msg.state == FLIGHT_DEPARTING) {
            pthread_t tid;
         pthread_attr_t attr;
         pthread_attr_init(&attr); // Initialize thread attributes
          
         ThreadArgs threadArgs;
-        threadArgs.msg = &msg;
+        threadArgs.flights = flights;
+        threadArgs.handle = msg.handle;
         threadArgs.runways = runways;
         threadArgs.num_runways = num_runways;
+        threadArgs.occupancy = &occupancy;
         threadArgs.msgqid = msgqid;
         threadArgs.airport_num = airport_num;
             pthread_create(&tid, &attr, handle_departure, (void*) &threadArgs);
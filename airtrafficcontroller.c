@@ -1,8 +1,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <string.h>
+#include <stdint.h>
 #include <sys/msg.h>
+#include <sys/shm.h>
 #include <stdbool.h>
+#include <errno.h>
+
+#include "ipc.h"
+#include "flight_table.h"
+#include "metrics.h"
 
 #define MAX_AIRPORTS 10
 #define PLANE_RCV_MSG_TYPE 1
@@ -10,6 +19,8 @@
 #define CLEANUP_MSG_TYPE 3
 #define AIRPORT_SND_MSG_TYPE 4
 #define AIRPORT_RCV_MSG_TYPE 5
+#define METRICS_SOCKET_NAME "atc_controller.sock"
+#define FLIGHT_REJECTED_AIRPORT -1 // arrival_airport sent back to a plane whose flight was rejected
 
 // Structure to store plane details
 typedef struct {
@@ -27,6 +38,56 @@ typedef struct {
     PlaneDetails details; // plane details
 } Message;
 
+// Structure to hold the counters exported on the metrics socket.
+// Only the message loop writes them (relaxed atomic adds, no locks) and
+// the exporter thread only reads them, so a scrape never delays a flight.
+typedef struct {
+    atomic_ulong flights_cleared;
+    atomic_ulong flights_rejected;
+    atomic_ulong takeoffs_confirmed;
+    atomic_ulong landings_confirmed;
+    atomic_ulong messages_received;
+    atomic_ulong messages_sent;
+} ControllerMetrics;
+
+// Structure to hold the context passed to write_metrics
+typedef struct {
+    int num_airports;
+    int msgqid;
+} MetricsArgs;
+
+static ControllerMetrics metrics;
+
+// Function to write all metrics in Prometheus text format
+void write_metrics(FILE *out, void *context) {
+    MetricsArgs *metricsArgs = (MetricsArgs*) context;
+    int num_airports = metricsArgs->num_airports;
+    struct msqid_ds queue_stats;
+    unsigned long queue_depth = 0;
+    if (msgctl(metricsArgs->msgqid, IPC_STAT, &queue_stats) == 0) {
+        queue_depth = queue_stats.msg_qnum;
+    }
+
+    fprintf(out, "# TYPE atc_airports gauge\n");
+    fprintf(out, "atc_airports %d\n", num_airports);
+    fprintf(out, "# TYPE atc_flights_cleared_total counter\n");
+    fprintf(out, "atc_flights_cleared_total %lu\n", metrics_read(&metrics.flights_cleared));
+    fprintf(out, "# TYPE atc_flights_rejected_total counter\n");
+    fprintf(out, "atc_flights_rejected_total %lu\n", metrics_read(&metrics.flights_rejected));
+    fprintf(out, "# TYPE atc_takeoffs_confirmed_total counter\n");
+    fprintf(out, "atc_takeoffs_confirmed_total %lu\n", metrics_read(&metrics.takeoffs_confirmed));
+    fprintf(out, "# TYPE atc_landings_confirmed_total counter\n");
+    fprintf(out, "atc_landings_confirmed_total %lu\n", metrics_read(&metrics.landings_confirmed));
+    fprintf(out, "# TYPE atc_messages_received_total counter\n");
+    fprintf(out, "atc_messages_received_total %lu\n", metrics_read(&metrics.messages_received));
+    fprintf(out, "# TYPE atc_messages_sent_total counter\n");
+    fprintf(out, "atc_messages_sent_total %lu\n", metrics_read(&metrics.messages_sent));
+    // All processes share one queue, so this is the global depth
+    fprintf(out, "# HELP atc_message_queue_depth Messages waiting in the queue shared by the ATC, airports and planes\n");
+    fprintf(out, "# TYPE atc_message_queue_depth gauge\n");
+    fprintf(out, "atc_message_queue_depth %lu\n", queue_depth);
+}
+
 // Function to initialize the air traffic controller
 int initialize_air_traffic_controller() {
     int num_airports;
@@ -47,7 +108,7 @@ int initialize_air_traffic_controller() {
 // Function to create a single message queue for communication
 int create_message_queue() {
     // Generate a unique key for the message queue
-    key_t key = ftok(".", 'g');
+    key_t key = get_ipc_key('g');
 
     // Create a message queue with read-write permissions
     int msgqid = msgget(key, 0666 | IPC_CREAT);
@@ -55,26 +116,136 @@ int create_message_queue() {
     return msgqid;
 }
 
+// Function to create and initialize the shared flight table
+FlightTable* create_flight_table(int *shmid) {
+    // Generate a unique key for the shared memory segment
+    key_t key = get_ipc_key(FLIGHT_TABLE_PROJ_ID);
+
+    *shmid = shmget(key, sizeof(FlightTable), 0666 | IPC_CREAT);
+    if (*shmid == -1) {
+        perror("shmget");
+        exit(EXIT_FAILURE);
+    }
+
+    FlightTable *flights = shmat(*shmid, NULL, 0);
+    if (flights == (void*) -1) {
+        perror("shmat");
+        exit(EXIT_FAILURE);
+    }
+
+    // Every slot starts free; hand out the lowest slots first
+    for (int i = 0; i < MAX_FLIGHTS; i++) {
+        flights->state[i] = FLIGHT_FREE;
+        flights->free_slots[i] = MAX_FLIGHTS - 1 - i;
+    }
+    flights->num_free_slots = MAX_FLIGHTS;
+
+    return flights;
+}
+
+// Function to store a plane in the flight table and return its handle
+FlightHandle allocate_flight(FlightTable *flights, const PlaneDetails *details) {
+    if (flights->num_free_slots == 0) {
+        printf("Flight table is full\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int slot = flights->free_slots[--flights->num_free_slots];
+    flights->plane_id[slot] = details->plane_id;
+    flights->departure_airport[slot] = details->departure_airport;
+    flights->arrival_airport[slot] = details->arrival_airport;
+    flights->total_weight[slot] = details->total_weight;
+    flights->plane_type[slot] = details->plane_type;
+    flights->num_passengers[slot] = details->num_passengers;
+    flights->state[slot] = FLIGHT_DEPARTING;
+
+    return ((FlightHandle) flights->generation[slot] << FLIGHT_SLOT_BITS) | slot;
+}
+
+// Function to return a flight's slot to the free list
+void release_flight(FlightTable *flights, FlightHandle handle) {
+    int slot = handle & FLIGHT_SLOT_MASK;
+
+    flights->state[slot] = FLIGHT_FREE;
+    flights->generation[slot]++;
+    flights->free_slots[flights->num_free_slots++] = slot;
+}
+
+// Function to send a flight handle and state to an airport
+void send_flight_message(int msgqid, long mtype, FlightTable *flights, FlightHandle handle, FlightState state) {
+    FlightMessage msg;
+    msg.mtype = mtype;
+    msg.handle = handle;
+    msg.state = state;
+
+    flights->state[handle & FLIGHT_SLOT_MASK] = state;
+    msgsnd(msgqid, &msg, sizeof(FlightMessage) - sizeof(long), 0);
+}
+
+// Function to drop a flight an airport could not handle and tell the plane
+void reject_flight(int msgqid, FlightTable *flights, FlightHandle handle, Message *plane_msg, int plane_id) {
+    release_flight(flights, handle);
+
+    plane_msg->mtype = plane_id+10;
+    plane_msg->details.arrival_airport = FLIGHT_REJECTED_AIRPORT;
+    msgsnd(msgqid, plane_msg, sizeof(Message) - sizeof(long), 0);
+    metrics_add(&metrics.messages_sent, 1);
+    metrics_add(&metrics.flights_rejected, 1);
+}
+
+// Function to receive an airport's reply about one flight. Replies carrying
+// another handle (e.g. a rejection of a stale handle) are discarded, so they
+// can never be taken for the reply to this flight.
+void receive_flight_reply(int msgqid, long mtype, FlightHandle handle, FlightMessage *reply) {
+    while (true) {
+        if (msgrcv(msgqid, reply, sizeof(FlightMessage) - sizeof(long), mtype, 0) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // The queue is gone; treat the flight as rejected
+            perror("msgrcv");
+            reply->handle = handle;
+            reply->state = FLIGHT_REJECTED;
+            return;
+        }
+        metrics_add(&metrics.messages_received, 1);
+        if (reply->handle == handle) {
+            return;
+        }
+        printf("Discarding reply for flight handle %u while waiting for %u\n", reply->handle, handle);
+    }
+}
+
 // Function to handle messages received from planes
-void handle_messages(int msgqid, int plane_id) {
+void handle_messages(int msgqid, FlightTable *flights, int plane_id) {
     // Declare a buffer for receiving messages
     Message plane_msg;
 
     // Receive a message with type 1 (plane details)
     msgrcv(msgqid, &plane_msg, sizeof(Message) - sizeof(long), plane_id, 0);
+    metrics_add(&metrics.messages_received, 1);
+
+    // Store the plane in the flight table; airports only get its handle
+    FlightHandle handle = allocate_flight(flights, &plane_msg.details);
 
-    // Forward the message to the appropriate departure airport
+    // Forward the flight to the appropriate departure airport
     printf("sent");
     //plane_msg.mtype = AIRPORT_SND_MSG_TYPE;
-    plane_msg.mtype = plane_msg.details.departure_airport + 20;
-    msgsnd(msgqid, &plane_msg, sizeof(Message) - sizeof(long), 0);
+    send_flight_message(msgqid, plane_msg.details.departure_airport + 20, flights, handle, FLIGHT_DEPARTING);
+    metrics_add(&metrics.messages_sent, 1);
     
     // Declare a buffer for receiving messages
-    Message departure_msg;
+    FlightMessage departure_msg;
 
-    // Receive a message with type 5 (departure details)
-    //msgrcv(msgqid, &departure_msg, sizeof(Message) - sizeof(long), AIRPORT_RCV_MSG_TYPE, 0);
-    msgrcv(msgqid, &departure_msg, sizeof(Message) - sizeof(long), plane_msg.details.departure_airport+30, 0);
+    // Receive the takeoff confirmation from the departure airport
+    receive_flight_reply(msgqid, plane_msg.details.departure_airport+30, handle, &departure_msg);
+    if (departure_msg.state == FLIGHT_REJECTED) {
+        printf("Departure rejected by Airport %d\n", plane_msg.details.departure_airport);
+        reject_flight(msgqid, flights, handle, &plane_msg, plane_id);
+        return;
+    }
+    metrics_add(&metrics.takeoffs_confirmed, 1);
+    flights->state[handle & FLIGHT_SLOT_MASK] = departure_msg.state;
     
     printf("Takeoff Message received from departure airport");
     // File pointer
@@ -90,22 +261,32 @@ void handle_messages(int msgqid, int plane_id) {
     // Close the file
     fclose(file);
     
-    // Forward the message to the appropriate arrival airport
+    // Forward the flight to the appropriate arrival airport
     //plane_msg.mtype = AIRPORT_SND_MSG_TYPE;
-    plane_msg.mtype = plane_msg.details.arrival_airport + 20;
-    msgsnd(msgqid, &plane_msg, sizeof(Message) - sizeof(long), 0);
+    send_flight_message(msgqid, plane_msg.details.arrival_airport + 20, flights, handle, FLIGHT_ARRIVING);
+    metrics_add(&metrics.messages_sent, 1);
     
     // Declare a buffer for receiving messages
-    Message arrival_msg;
+    FlightMessage arrival_msg;
 
-    // Receive a message with type 5 (arrival details)
-    msgrcv(msgqid, &arrival_msg, sizeof(Message) - sizeof(long), plane_msg.details.arrival_airport+30, 0);
+    // Receive the landing confirmation from the arrival airport
+    receive_flight_reply(msgqid, plane_msg.details.arrival_airport+30, handle, &arrival_msg);
+    if (arrival_msg.state == FLIGHT_REJECTED) {
+        printf("Arrival rejected by Airport %d\n", plane_msg.details.arrival_airport);
+        reject_flight(msgqid, flights, handle, &plane_msg, plane_id);
+        return;
+    }
+    metrics_add(&metrics.landings_confirmed, 1);
+    flights->state[handle & FLIGHT_SLOT_MASK] = arrival_msg.state;
     
     printf("Arrival Message received from arrival airport");
+    release_flight(flights, handle);
 
     // Send confirmation message back to the plane
     plane_msg.mtype = plane_id+10;
     msgsnd(msgqid, &plane_msg, sizeof(Message) - sizeof(long), 0);
+    metrics_add(&metrics.messages_sent, 1);
+    metrics_add(&metrics.flights_cleared, 1);
 }
 
 int main() {
@@ -115,13 +296,27 @@ int main() {
     // Create a single message queue for communication
     int msgqid = create_message_queue();
 
+    // Create the flight table shared with the airports
+    int shmid;
+    FlightTable *flights = create_flight_table(&shmid);
+
+    // Start the metrics exporter so operators can scrape the controller
+    MetricsArgs metricsArgs;
+    metricsArgs.num_airports = num_airports;
+    metricsArgs.msgqid = msgqid;
+    MetricsExporter exporter;
+    snprintf(exporter.socket_name, sizeof(exporter.socket_name), "%s", METRICS_SOCKET_NAME);
+    exporter.write_metrics = write_metrics;
+    exporter.context = &metricsArgs;
+    start_metrics_exporter(&exporter);
+
     // Main loop to handle incoming messages
     int plane_id = 1;
     while (true) {
    	
 
         // Receive message from either plane or airport
-        handle_messages(msgqid, plane_id);
+        handle_messages(msgqid, flights, plane_id);
    
         // Declare a buffer for receiving messages
         Message msg;
@@ -131,6 +326,9 @@ int main() {
     
         if(msg.details.plane_id == -1){
             msgctl(msgqid,IPC_RMID,NULL);
+            shmdt(flights);
+            shmctl(shmid, IPC_RMID, NULL);
+            remove_metrics_socket(METRICS_SOCKET_NAME);
     	    return 1;
         }
         plane_id++;
@@ -0,0 +1,507 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#include "occupancy.h"
+
+#define MAX_AIRPORTS 10
+#define MAX_RUNWAYS 10
+#define BACKUP_RUNWAY_LOAD_CAPACITY 15000
+#define MAX_PASSENGERS 10
+#define MAX_WEIGHT 100
+#define MIN_WEIGHT 10
+#define NUM_CREW_MEMBERS 7
+#define NUM_CREW_MEMBERS_CARGO 2
+#define AVG_CREW_WEIGHT 75
+#define MAX_CARGO_ITEMS 100
+#define MAX_AVG_CARGO_WEIGHT 100
+#define DELAY_BIN_WIDTH 0.5 // seconds per delay histogram bin
+#define DELAY_BINS 7200 // delays past the last bin are counted as overflow
+#define CACHE_LINE_SIZE 64
+
+// Structure to store plane details
+typedef struct {
+    int plane_id;
+    int departure_airport;
+    int arrival_airport;
+    double total_weight;
+    int plane_type; // 0 for cargo, 1 for passenger
+    int num_passengers; // Relevant only for passenger planes
+} PlaneDetails;
+
+// Structure to describe one airport of the simulated topology
+typedef struct {
+    int num_runways;
+    double load_capacity[MAX_RUNWAYS + 1]; // +1 for backup runway
+} AirportConfig;
+
+// Structure to hold the parameters shared by every simulation run
+typedef struct {
+    int num_airports;
+    AirportConfig airports[MAX_AIRPORTS];
+    OccupancyModel occupancy;
+    int num_runs;
+    int num_flights;
+    double mean_request_interval;
+    int passenger_percentage;
+    uint64_t seed;
+} SimulationConfig;
+
+// Structure for a pending runway request in the event queue
+typedef struct {
+    double time;
+    int flight;
+    bool is_arrival;
+} Event;
+
+// Structure to store the summary of a single simulation run
+typedef struct {
+    double makespan;
+    double throughput; // flights per hour
+    double mean_delay;
+    int backup_fallbacks;
+} RunResult;
+
+// Structure holding everything one worker thread writes. Workers never share
+// a cache line, so runs scale with the number of cores.
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) const SimulationConfig *config;
+    RunResult *results;
+    atomic_int *next_run;
+    PlaneDetails *flights;
+    Event *events;
+    double runway_busy[MAX_AIRPORTS][MAX_RUNWAYS + 1];
+    double total_makespan;
+    unsigned long delay_histogram[DELAY_BINS + 1]; // +1 for overflow
+    double max_delay;
+} Worker;
+
+// Function to mix a seed into a well-distributed 64-bit state (splitmix64)
+uint64_t mix_seed(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Function to draw the next random number of a run (xorshift64*)
+uint64_t next_random(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545f4914f6cdd1dULL;
+}
+
+// Function to draw a random integer between min and max (inclusive)
+int random_between(uint64_t *state, int min, int max) {
+    return min + (int) (next_random(state) % (uint64_t) (max - min + 1));
+}
+
+// Function to draw a random number in [0, 1)
+double random_unit(uint64_t *state) {
+    return (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Function to generate a random plane using the same limits as plane.c
+PlaneDetails generate_plane(const SimulationConfig *config, uint64_t *state, int plane_id) {
+    PlaneDetails plane;
+    plane.plane_id = plane_id;
+    plane.plane_type = random_between(state, 1, 100) <= config->passenger_percentage;
+
+    if (plane.plane_type == 1) {
+        plane.num_passengers = random_between(state, 1, MAX_PASSENGERS);
+        double total_passenger_weight = 0;
+        for (int i = 0; i < plane.num_passengers; i++) {
+            total_passenger_weight += random_between(state, MIN_WEIGHT, MAX_WEIGHT);
+        }
+        plane.total_weight = NUM_CREW_MEMBERS * AVG_CREW_WEIGHT + total_passenger_weight;
+    } else {
+        plane.num_passengers = 0;
+        int num_cargo_items = random_between(state, 1, MAX_CARGO_ITEMS);
+        int avg_cargo_weight = random_between(state, 1, MAX_AVG_CARGO_WEIGHT);
+        plane.total_weight = num_cargo_items * avg_cargo_weight + NUM_CREW_MEMBERS_CARGO * AVG_CREW_WEIGHT;
+    }
+
+    plane.departure_airport = random_between(state, 1, config->num_airports);
+    plane.arrival_airport = random_between(state, 1, config->num_airports - 1);
+    if (plane.arrival_airport >= plane.departure_airport) {
+        plane.arrival_airport++;
+    }
+
+    return plane;
+}
+
+// Function to compare two events, breaking ties by flight for reproducible runs
+bool event_before(const Event *a, const Event *b) {
+    return a->time < b->time || (a->time == b->time && a->flight < b->flight);
+}
+
+// Function to add an event to the min-heap
+void push_event(Event *events, int *num_events, Event event) {
+    int i = (*num_events)++;
+    while (i > 0 && event_before(&event, &events[(i - 1) / 2])) {
+        events[i] = events[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    events[i] = event;
+}
+
+// Function to remove the earliest event from the min-heap
+Event pop_event(Event *events, int *num_events) {
+    Event top = events[0];
+    Event last = events[--(*num_events)];
+    int i = 0;
+
+    while (2 * i + 1 < *num_events) {
+        int child = 2 * i + 1;
+        if (child + 1 < *num_events && event_before(&events[child + 1], &events[child])) {
+            child++;
+        }
+        if (!event_before(&events[child], &last)) {
+            break;
+        }
+        events[i] = events[child];
+        i = child;
+    }
+    events[i] = last;
+
+    return top;
+}
+
+// Function to select the runway that can serve the plane soonest, where a
+// runway serves it at max(free_at, now). Ties go to the best fit, and the
+// backup runway is only used when it serves the plane strictly sooner.
+// Returns -1 if no runway, backup included, can carry the load.
+int select_runway(const AirportConfig *airport, const double *free_at, double now, double total_weight) {
+    int selected_runway = -1;
+    double earliest_start = INFINITY;
+    double min_difference = INFINITY;
+
+    for (int i = 0; i <= airport->num_runways; ++i) {
+        double difference = airport->load_capacity[i] - total_weight;
+        if (difference < 0) {
+            continue;
+        }
+
+        double start = free_at[i] > now ? free_at[i] : now;
+        if (start < earliest_start || (start == earliest_start && i < airport->num_runways && difference < min_difference)) {
+            earliest_start = start;
+            min_difference = difference;
+            selected_runway = i;
+        }
+    }
+
+    return selected_runway;
+}
+
+// Function to add a runway wait to the worker's delay histogram
+void record_delay(Worker *worker, double delay) {
+    double bin = delay / DELAY_BIN_WIDTH;
+    worker->delay_histogram[bin < DELAY_BINS ? (int) bin : DELAY_BINS]++;
+
+    if (delay > worker->max_delay) {
+        worker->max_delay = delay;
+    }
+}
+
+// Function to simulate one seeded run of the whole topology
+RunResult simulate_run(Worker *worker, int run) {
+    const SimulationConfig *config = worker->config;
+    double free_at[MAX_AIRPORTS][MAX_RUNWAYS + 1] = {{0}};
+    double busy[MAX_AIRPORTS][MAX_RUNWAYS + 1] = {{0}};
+    uint64_t state = mix_seed(config->seed + (uint64_t) run) | 1;
+    RunResult result = {0};
+    double total_delay = 0;
+    int num_events = 0;
+    double now = 0;
+
+    // Planes ask the air traffic controller for departure at random intervals
+    for (int i = 0; i < config->num_flights; i++) {
+        worker->flights[i] = generate_plane(config, &state, i + 1);
+        now += -config->mean_request_interval * log1p(-random_unit(&state));
+
+        Event departure = { now, i, false };
+        push_event(worker->events, &num_events, departure);
+    }
+
+    // Serve runway requests in time order; departures hand over to the arrival airport
+    while (num_events > 0) {
+        Event event = pop_event(worker->events, &num_events);
+        PlaneDetails *plane = &worker->flights[event.flight];
+        int airport_index = (event.is_arrival ? plane->arrival_airport : plane->departure_airport) - 1;
+        const AirportConfig *airport = &config->airports[airport_index];
+
+        int selected_runway = select_runway(airport, free_at[airport_index], event.time, plane->total_weight);
+        if (selected_runway == airport->num_runways) {
+            result.backup_fallbacks++;
+        }
+
+        double start = event.time;
+        if (free_at[airport_index][selected_runway] > start) {
+            start = free_at[airport_index][selected_runway];
+        }
+        double occupancy = turnaround_time(&config->occupancy, plane->plane_type, plane->num_passengers, plane->total_weight)
+            + runway_roll_time(&config->occupancy, plane->total_weight);
+        double end = start + occupancy;
+
+        // The runway reopens only after the separation gap
+        free_at[airport_index][selected_runway] = end + config->occupancy.separation_gap;
+        busy[airport_index][selected_runway] += occupancy + config->occupancy.separation_gap;
+        total_delay += start - event.time;
+        record_delay(worker, start - event.time);
+
+        if (!event.is_arrival) {
+            Event arrival = { end, event.flight, true };
+            push_event(worker->events, &num_events, arrival);
+        } else if (end > result.makespan) {
+            result.makespan = end;
+        }
+    }
+
+    for (int a = 0; a < config->num_airports; a++) {
+        for (int r = 0; r <= config->airports[a].num_runways; r++) {
+            worker->runway_busy[a][r] += busy[a][r];
+        }
+    }
+    worker->total_makespan += result.makespan;
+
+    result.throughput = result.makespan > 0 ? config->num_flights * 3600.0 / result.makespan : 0;
+    result.mean_delay = total_delay / (2.0 * config->num_flights);
+
+    return result;
+}
+
+// Function run by each worker thread until all runs have been claimed
+void* run_simulations(void *args) {
+    Worker *worker = (Worker*) args;
+
+    while (true) {
+        int run = atomic_fetch_add_explicit(worker->next_run, 1, memory_order_relaxed);
+        if (run >= worker->config->num_runs) {
+            break;
+        }
+        worker->results[run] = simulate_run(worker, run);
+    }
+
+    return NULL;
+}
+
+// Function to find a percentile of the merged delay histogram (lower edge of its bin).
+// Returns INFINITY if the percentile falls past the last bin.
+double delay_percentile(const unsigned long *histogram, unsigned long total, double percentile) {
+    unsigned long target = (unsigned long) (percentile / 100.0 * total);
+    unsigned long seen = 0;
+
+    for (int i = 0; i < DELAY_BINS; i++) {
+        seen += histogram[i];
+        if (seen > target) {
+            return i * DELAY_BIN_WIDTH;
+        }
+    }
+
+    return INFINITY;
+}
+
+// Function to format a delay percentile, showing overflow as a lower bound
+const char* format_percentile(char *buffer, size_t size, double percentile) {
+    if (isinf(percentile)) {
+        snprintf(buffer, size, ">= %.1f", DELAY_BINS * DELAY_BIN_WIDTH);
+    } else {
+        snprintf(buffer, size, "%.1f", percentile);
+    }
+    return buffer;
+}
+
+// Function to read the topology and the run parameters
+void initialize_simulation(SimulationConfig *config) {
+    printf("Enter the number of airports to be simulated (2 to %d): ", MAX_AIRPORTS);
+    scanf("%d", &config->num_airports);
+    while (config->num_airports < 2 || config->num_airports > MAX_AIRPORTS) {
+        printf("Invalid input. Please enter a number between 2 and %d: ", MAX_AIRPORTS);
+        scanf("%d", &config->num_airports);
+    }
+
+    for (int a = 0; a < config->num_airports; a++) {
+        AirportConfig *airport = &config->airports[a];
+
+        printf("Enter number of Runways for Airport %d (1 to %d): ", a + 1, MAX_RUNWAYS);
+        scanf("%d", &airport->num_runways);
+        while (airport->num_runways < 1 || airport->num_runways > MAX_RUNWAYS) {
+            printf("Invalid input. Please enter a number between 1 and %d: ", MAX_RUNWAYS);
+            scanf("%d", &airport->num_runways);
+        }
+
+        printf("Enter loadCapacity of Runways for Airport %d (give as a space separated list in a single line): ", a + 1);
+        for (int r = 0; r < airport->num_runways; r++) {
+            scanf("%lf", &airport->load_capacity[r]);
+        }
+        airport->load_capacity[airport->num_runways] = BACKUP_RUNWAY_LOAD_CAPACITY;
+    }
+
+    initialize_occupancy_model(&config->occupancy);
+
+    printf("Enter number of simulation runs: ");
+    scanf("%d", &config->num_runs);
+    while (config->num_runs < 1) {
+        printf("Invalid input. Please enter a positive number: ");
+        scanf("%d", &config->num_runs);
+    }
+
+    printf("Enter number of flights per run: ");
+    scanf("%d", &config->num_flights);
+    while (config->num_flights < 1) {
+        printf("Invalid input. Please enter a positive number: ");
+        scanf("%d", &config->num_flights);
+    }
+
+    printf("Enter mean time between flight requests in seconds: ");
+    scanf("%lf", &config->mean_request_interval);
+    while (config->mean_request_interval <= 0) {
+        printf("Invalid input. Please enter a positive number: ");
+        scanf("%lf", &config->mean_request_interval);
+    }
+
+    printf("Enter percentage of Passenger planes (0 to 100): ");
+    scanf("%d", &config->passenger_percentage);
+    while (config->passenger_percentage < 0 || config->passenger_percentage > 100) {
+        printf("Invalid input. Please enter a number between 0 and 100: ");
+        scanf("%d", &config->passenger_percentage);
+    }
+
+    unsigned long long seed;
+    printf("Enter random seed: ");
+    scanf("%llu", &seed);
+    config->seed = seed;
+}
+
+// Function to print throughput, utilization and delay statistics over all runs
+void print_report(const SimulationConfig *config, const RunResult *results, Worker *workers, int num_workers) {
+    double min_throughput = results[0].throughput;
+    double max_throughput = results[0].throughput;
+    double sum_throughput = 0;
+    double sum_mean_delay = 0;
+    long backup_fallbacks = 0;
+
+    for (int i = 0; i < config->num_runs; i++) {
+        if (results[i].throughput < min_throughput) {
+            min_throughput = results[i].throughput;
+        }
+        if (results[i].throughput > max_throughput) {
+            max_throughput = results[i].throughput;
+        }
+        sum_throughput += results[i].throughput;
+        sum_mean_delay += results[i].mean_delay;
+        backup_fallbacks += results[i].backup_fallbacks;
+    }
+
+    // Merge the per-worker accumulators only once all runs are done
+    static unsigned long histogram[DELAY_BINS + 1];
+    double runway_busy[MAX_AIRPORTS][MAX_RUNWAYS + 1] = {{0}};
+    double total_makespan = 0;
+    double max_delay = 0;
+    unsigned long total_requests = 0;
+
+    for (int w = 0; w < num_workers; w++) {
+        for (int i = 0; i <= DELAY_BINS; i++) {
+            histogram[i] += workers[w].delay_histogram[i];
+            total_requests += workers[w].delay_histogram[i];
+        }
+        for (int a = 0; a < config->num_airports; a++) {
+            for (int r = 0; r <= config->airports[a].num_runways; r++) {
+                runway_busy[a][r] += workers[w].runway_busy[a][r];
+            }
+        }
+        total_makespan += workers[w].total_makespan;
+        if (workers[w].max_delay > max_delay) {
+            max_delay = workers[w].max_delay;
+        }
+    }
+
+    printf("\nThroughput (flights/hour): mean %.2f, min %.2f, max %.2f\n",
+           sum_throughput / config->num_runs, min_throughput, max_throughput);
+    char p50[32], p90[32], p99[32];
+    printf("Runway wait (seconds): mean %.2f, p50 %s, p90 %s, p99 %s, max %.2f\n",
+           sum_mean_delay / config->num_runs,
+           format_percentile(p50, sizeof(p50), delay_percentile(histogram, total_requests, 50)),
+           format_percentile(p90, sizeof(p90), delay_percentile(histogram, total_requests, 90)),
+           format_percentile(p99, sizeof(p99), delay_percentile(histogram, total_requests, 99)),
+           max_delay);
+    printf("Backup runway fallbacks: %.2f per run\n", (double) backup_fallbacks / config->num_runs);
+
+    for (int a = 0; a < config->num_airports; a++) {
+        printf("Airport %d runway utilization:", a + 1);
+        for (int r = 0; r <= config->airports[a].num_runways; r++) {
+            double utilization = total_makespan > 0 ? 100.0 * runway_busy[a][r] / total_makespan : 0;
+            printf(" %s%d=%.1f%%", r == config->airports[a].num_runways ? "backup/" : "", r + 1, utilization);
+        }
+        printf("\n");
+    }
+}
+
+int main() {
+    static SimulationConfig config;
+    initialize_simulation(&config);
+
+    // Use one worker per core; runs are independent so no worker ever waits on another
+    int num_workers = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_workers < 1) {
+        num_workers = 1;
+    }
+    if (num_workers > config.num_runs) {
+        num_workers = config.num_runs;
+    }
+
+    RunResult *results = calloc(config.num_runs, sizeof(RunResult));
+    Worker *workers = aligned_alloc(CACHE_LINE_SIZE, num_workers * sizeof(Worker));
+    pthread_t *tids = malloc(num_workers * sizeof(pthread_t));
+    if (results == NULL || workers == NULL || tids == NULL) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    memset(workers, 0, num_workers * sizeof(Worker));
+    atomic_int next_run = 0;
+
+    struct timespec started, finished;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    for (int w = 0; w < num_workers; w++) {
+        workers[w].config = &config;
+        workers[w].results = results;
+        workers[w].next_run = &next_run;
+        workers[w].flights = malloc(config.num_flights * sizeof(PlaneDetails));
+        workers[w].events = malloc(config.num_flights * sizeof(Event));
+        if (workers[w].flights == NULL || workers[w].events == NULL) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        pthread_create(&tids[w], NULL, run_simulations, (void*) &workers[w]);
+    }
+
+    for (int w = 0; w < num_workers; w++) {
+        pthread_join(tids[w], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    double elapsed = (finished.tv_sec - started.tv_sec) + (finished.tv_nsec - started.tv_nsec) / 1e9;
+    printf("Completed %d runs of %d flights on %d threads in %.3f seconds\n",
+           config.num_runs, config.num_flights, num_workers, elapsed);
+
+    print_report(&config, results, workers, num_workers);
+
+    for (int w = 0; w < num_workers; w++) {
+        free(workers[w].flights);
+        free(workers[w].events);
+    }
+    free(workers);
+    free(tids);
+    free(results);
+
+    return 0;
+}
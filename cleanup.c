@@ -4,6 +4,8 @@
 #include <sys/msg.h>
 #include <stdbool.h>
 
+#include "ipc.h"
+
 #define CLEANUP_MSG_TYPE 3
 
 // Structure to store plane details
@@ -46,7 +48,7 @@ void send_termination_message(int msgqid) {
 
 int main() {
     // Create a single message queue for communication
-    key_t key = ftok(".", 'g'); // Generate a unique key for the message queue
+    key_t key = get_ipc_key('g'); // Generate a unique key for the message queue
     int msgqid = msgget(key, 0666 | IPC_CREAT); // Create a message queue with read-write permissions
 
     // Main loop to handle termination input
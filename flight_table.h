@@ -0,0 +1,47 @@
+#ifndef ATC_FLIGHT_TABLE_H
+#define ATC_FLIGHT_TABLE_H
+
+#include <stdint.h>
+
+#define FLIGHT_TABLE_PROJ_ID 'f' // ftok project id of the shared flight table
+#define MAX_FLIGHTS 1024
+#define FLIGHT_SLOT_BITS 16
+#define FLIGHT_SLOT_MASK ((1u << FLIGHT_SLOT_BITS) - 1)
+
+// Flight states carried with a flight handle between the ATC and the airports
+typedef enum {
+    FLIGHT_FREE,
+    FLIGHT_DEPARTING, // ATC -> departure airport
+    FLIGHT_DEPARTED, // departure airport -> ATC
+    FLIGHT_ARRIVING, // ATC -> arrival airport
+    FLIGHT_ARRIVED, // arrival airport -> ATC
+    FLIGHT_REJECTED // airport -> ATC, the flight could not be handled
+} FlightState;
+
+// Compact reference to a flight table slot: generation << FLIGHT_SLOT_BITS | slot.
+// The generation changes every time a slot is reused, so stale handles are detected.
+typedef uint32_t FlightHandle;
+
+// Flight table owned by the ATC in shared memory, one array per field so each
+// hop only touches the fields it needs. Slots are handed out from a free list.
+typedef struct {
+    int plane_id[MAX_FLIGHTS];
+    int departure_airport[MAX_FLIGHTS];
+    int arrival_airport[MAX_FLIGHTS];
+    double total_weight[MAX_FLIGHTS];
+    int plane_type[MAX_FLIGHTS]; // 0 for cargo, 1 for passenger
+    int num_passengers[MAX_FLIGHTS]; // Relevant only for passenger planes
+    int state[MAX_FLIGHTS];
+    uint16_t generation[MAX_FLIGHTS];
+    uint16_t free_slots[MAX_FLIGHTS];
+    int num_free_slots;
+} FlightTable;
+
+// Structure for hop messages between the ATC and the airports
+typedef struct {
+    long mtype; // message type
+    FlightHandle handle; // flight table reference
+    int state; // FlightState
+} FlightMessage;
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef ATC_IPC_H
+#define ATC_IPC_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ipc.h>
+
+#define IPC_PATH_ENV "ATC_IPC_PATH"
+
+// Function to get the directory that namespaces a session's queue, shared memory and sockets.
+// Sessions started with different ATC_IPC_PATH directories never share any of them.
+static const char* get_ipc_path() {
+    const char *path = getenv(IPC_PATH_ENV);
+    if (path == NULL || path[0] == '\0') {
+        path = ".";
+    }
+
+    return path;
+}
+
+// Function to generate the key for the System V IPC objects
+static key_t get_ipc_key(int proj_id) {
+    key_t key = ftok(get_ipc_path(), proj_id);
+
+    // A missing directory must not fall back to the shared key -1
+    if (key == -1) {
+        perror(IPC_PATH_ENV);
+        exit(EXIT_FAILURE);
+    }
+
+    return key;
+}
+
+#endif
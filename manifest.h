@@ -0,0 +1,20 @@
+#ifndef ATC_MANIFEST_H
+#define ATC_MANIFEST_H
+
+#include <stdint.h>
+
+#define MANIFEST_MAGIC 0x4d435441 // "ATCM"
+#define MANIFEST_VERSION 1
+#define MANIFEST_ALIGNMENT 64
+
+// Header of a cargo manifest file. It is followed, at weights_offset, by one
+// contiguous column of item_count doubles holding the item weights in kgs.
+// All fields are in the byte order of the machine that wrote the file.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t item_count;
+    uint64_t weights_offset; // multiple of MANIFEST_ALIGNMENT
+} ManifestHeader;
+
+#endif
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "manifest.h"
+
+#define MAX_PATH_LENGTH 256
+#define WRITE_BATCH 4096
+
+// Function to convert a text list of item weights into a cargo manifest.
+// Returns the number of items written, or -1 on error.
+long long write_cargo_manifest(FILE *in, FILE *out) {
+    ManifestHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MANIFEST_MAGIC;
+    header.version = MANIFEST_VERSION;
+    header.weights_offset = MANIFEST_ALIGNMENT;
+
+    // Write the header with padding up to the aligned weight column
+    char padding[MANIFEST_ALIGNMENT] = {0};
+    memcpy(padding, &header, sizeof(header));
+    if (fwrite(padding, sizeof(padding), 1, out) != 1) {
+        perror("fwrite");
+        return -1;
+    }
+
+    // Append the weights in batches
+    double batch[WRITE_BATCH];
+    size_t batch_size = 0;
+    while (fscanf(in, "%lf", &batch[batch_size]) == 1) {
+        header.item_count++;
+        if (++batch_size == WRITE_BATCH) {
+            if (fwrite(batch, sizeof(double), batch_size, out) != batch_size) {
+                perror("fwrite");
+                return -1;
+            }
+            batch_size = 0;
+        }
+    }
+    if (!feof(in)) {
+        printf("Invalid weight after item %llu\n", (unsigned long long) header.item_count);
+        return -1;
+    }
+    if (fwrite(batch, sizeof(double), batch_size, out) != batch_size) {
+        perror("fwrite");
+        return -1;
+    }
+
+    // Now that the item count is known, rewrite the header
+    if (fseek(out, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, out) != 1) {
+        perror("fwrite");
+        return -1;
+    }
+
+    return (long long) header.item_count;
+}
+
+int main() {
+    char input_path[MAX_PATH_LENGTH];
+    char output_path[MAX_PATH_LENGTH];
+
+    // Prompt for the text file with one item weight in kgs per line
+    printf("Enter Cargo Item Weights File (one weight in kgs per line): ");
+    scanf("%255s", input_path);
+
+    // Prompt for the manifest to create
+    printf("Enter Cargo Manifest File to create: ");
+    scanf("%255s", output_path);
+
+    FILE *in = fopen(input_path, "r");
+    if (in == NULL) {
+        perror("fopen");
+        return 1;
+    }
+    FILE *out = fopen(output_path, "wb");
+    if (out == NULL) {
+        perror("fopen");
+        fclose(in);
+        return 1;
+    }
+
+    long long item_count = write_cargo_manifest(in, out);
+    fclose(in);
+    if (fclose(out) != 0) {
+        perror("fclose");
+        item_count = -1;
+    }
+    if (item_count < 0) {
+        remove(output_path);
+        return 1;
+    }
+
+    printf("Cargo Manifest %s written with %lld items\n", output_path, item_count);
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+#ifndef ATC_METRICS_H
+#define ATC_METRICS_H
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "ipc.h"
+
+#define METRICS_SOCKET_NAME_LENGTH 64
+#define METRICS_ACCEPT_RETRY_USEC 100000 // back-off when accept keeps failing, e.g. EMFILE
+
+// Function writing one program's metrics in Prometheus text format
+typedef void (*MetricsWriter)(FILE *out, void *context);
+
+// Structure to hold metrics exporter thread arguments
+typedef struct {
+    char socket_name[METRICS_SOCKET_NAME_LENGTH]; // file name inside the ATC_IPC_PATH directory
+    MetricsWriter write_metrics;
+    void *context; // passed to write_metrics
+} MetricsExporter;
+
+// Function to add to a metrics counter without synchronising with readers
+static inline void metrics_add(atomic_ulong *counter, unsigned long value) {
+    atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
+
+// Function to read a metrics counter
+static inline unsigned long metrics_read(atomic_ulong *counter) {
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+// Function to build the path of a metrics socket inside the ATC_IPC_PATH directory
+static inline bool metrics_socket_path(const char *socket_name, struct sockaddr_un *addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (snprintf(addr->sun_path, sizeof(addr->sun_path), "%s/%s", get_ipc_path(), socket_name) >= (int) sizeof(addr->sun_path)) {
+        printf("Metrics socket path is too long, set a shorter %s\n", IPC_PATH_ENV);
+        return false;
+    }
+
+    return true;
+}
+
+// Function to remove a metrics socket when its program shuts down
+static inline void remove_metrics_socket(const char *socket_name) {
+    struct sockaddr_un addr;
+    if (metrics_socket_path(socket_name, &addr)) {
+        unlink(addr.sun_path);
+    }
+}
+
+// Function to serve metrics to every client connecting to the Unix socket
+static inline void* export_metrics(void *args) {
+    MetricsExporter *exporter = (MetricsExporter*) args;
+    struct sockaddr_un addr;
+
+    if (!metrics_socket_path(exporter->socket_name, &addr)) {
+        return NULL;
+    }
+
+    int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_fd == -1) {
+        perror("socket");
+        return NULL;
+    }
+
+    // Remove a stale socket left behind by a previous run
+    unlink(addr.sun_path);
+    if (bind(server_fd, (struct sockaddr*) &addr, sizeof(addr)) == -1 || listen(server_fd, 4) == -1) {
+        perror("metrics socket");
+        close(server_fd);
+        return NULL;
+    }
+
+    while (true) {
+        int client_fd = accept(server_fd, NULL, NULL);
+        if (client_fd == -1) {
+            // Do not spin on persistent failures such as running out of descriptors
+            if (errno != EINTR) {
+                usleep(METRICS_ACCEPT_RETRY_USEC);
+            }
+            continue;
+        }
+
+        FILE *out = fdopen(client_fd, "w");
+        if (out == NULL) {
+            close(client_fd);
+            continue;
+        }
+        exporter->write_metrics(out, exporter->context);
+        // A scraper that disconnects early only loses its own response
+        if (fclose(out) == EOF && errno != EPIPE && errno != ECONNRESET) {
+            perror("metrics write");
+        }
+    }
+
+    return NULL;
+}
+
+// Function to start the metrics exporter thread
+static inline void start_metrics_exporter(MetricsExporter *exporter) {
+    // Writes to a disconnected scraper must fail with EPIPE instead of killing the process
+    signal(SIGPIPE, SIG_IGN);
+
+    pthread_t metrics_tid;
+    pthread_create(&metrics_tid, NULL, export_metrics, (void*) exporter);
+    pthread_detach(metrics_tid);
+}
+
+#endif
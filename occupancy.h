@@ -0,0 +1,77 @@
+#ifndef ATC_OCCUPANCY_H
+#define ATC_OCCUPANCY_H
+
+#include <stdio.h>
+
+#define DEFAULT_PASSENGER_TURNAROUND_BASE 1.5
+#define DEFAULT_CARGO_TURNAROUND_BASE 1.0
+#define DEFAULT_TURNAROUND_PER_PASSENGER 0.3
+#define DEFAULT_TURNAROUND_PER_CARGO_TONNE 0.75
+#define DEFAULT_RUNWAY_ROLL_BASE 1.5
+#define DEFAULT_RUNWAY_ROLL_PER_TONNE 0.2
+#define DEFAULT_SEPARATION_GAP 1.0
+
+// Structure to hold the runway occupancy model (all times in seconds).
+// Shared by airport.c and capacityplanner.c so simulated and live service times agree.
+typedef struct {
+    double turnaround_base[2]; // boarding/loading base time, indexed by plane_type
+    double turnaround_per_passenger;
+    double turnaround_per_cargo_tonne;
+    double runway_roll_base; // takeoff/landing
+    double runway_roll_per_tonne;
+    double separation_gap; // runway stays closed after each movement
+} OccupancyModel;
+
+// Function to read one non-negative model parameter
+static void read_occupancy_parameter(const char *prompt, double *value) {
+    printf("%s", prompt);
+    scanf("%lf", value);
+
+    // Validate the parameter
+    while (!(*value >= 0)) {
+        printf("Invalid input. Please enter a number of seconds that is 0 or more: ");
+        scanf("%lf", value);
+    }
+}
+
+// Function to set up the runway occupancy model, optionally from user input
+static void initialize_occupancy_model(OccupancyModel *model) {
+    model->turnaround_base[0] = DEFAULT_CARGO_TURNAROUND_BASE;
+    model->turnaround_base[1] = DEFAULT_PASSENGER_TURNAROUND_BASE;
+    model->turnaround_per_passenger = DEFAULT_TURNAROUND_PER_PASSENGER;
+    model->turnaround_per_cargo_tonne = DEFAULT_TURNAROUND_PER_CARGO_TONNE;
+    model->runway_roll_base = DEFAULT_RUNWAY_ROLL_BASE;
+    model->runway_roll_per_tonne = DEFAULT_RUNWAY_ROLL_PER_TONNE;
+    model->separation_gap = DEFAULT_SEPARATION_GAP;
+
+    char choice;
+    printf("Use default runway occupancy model? (Y for Yes and N for No): ");
+    scanf(" %c", &choice);
+    if (choice != 'N' && choice != 'n') {
+        return;
+    }
+
+    read_occupancy_parameter("Enter boarding/loading base time in seconds for Cargo planes: ", &model->turnaround_base[0]);
+    read_occupancy_parameter("Enter boarding/loading base time in seconds for Passenger planes: ", &model->turnaround_base[1]);
+    read_occupancy_parameter("Enter boarding/loading time in seconds per passenger: ", &model->turnaround_per_passenger);
+    read_occupancy_parameter("Enter loading time in seconds per tonne of cargo plane weight: ", &model->turnaround_per_cargo_tonne);
+    read_occupancy_parameter("Enter takeoff/landing base time in seconds: ", &model->runway_roll_base);
+    read_occupancy_parameter("Enter takeoff/landing time in seconds per tonne: ", &model->runway_roll_per_tonne);
+    read_occupancy_parameter("Enter runway separation gap in seconds: ", &model->separation_gap);
+}
+
+// Function to get the boarding/loading (or deboarding/unloading) time of a plane
+static double turnaround_time(const OccupancyModel *model, int plane_type, int num_passengers, double total_weight) {
+    if (plane_type == 1) {
+        return model->turnaround_base[1] + num_passengers * model->turnaround_per_passenger;
+    }
+
+    return model->turnaround_base[0] + total_weight / 1000 * model->turnaround_per_cargo_tonne;
+}
+
+// Function to get the takeoff (or landing) time of a plane
+static double runway_roll_time(const OccupancyModel *model, double total_weight) {
+    return model->runway_roll_base + total_weight / 1000 * model->runway_roll_per_tonne;
+}
+
+#endif
@@ -1,9 +1,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
 #include <sys/msg.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <stdbool.h>
 
+#include "ipc.h"
+#include "manifest.h"
+
 #define MAX_PASSENGERS 10
 #define MAX_WEIGHT 100
 #define MIN_WEIGHT 10
@@ -12,6 +21,9 @@
 #define AVG_CREW_WEIGHT 75
 #define MAX_AIRPORT_NUM 10
 #define MIN_AIRPORT_NUM 1
+#define FLIGHT_REJECTED_AIRPORT -1 // arrival_airport in the ATC reply when an airport rejected the flight
+#define MANIFEST_LANES 8
+#define MAX_PATH_LENGTH 256
 
 
 // Structure to store plane details
@@ -30,6 +42,19 @@ typedef struct {
     PlaneDetails details; // plane details
 } Message;
 
+// Vector of manifest weights and the matching lane mask (-1 for true, 0 for false)
+typedef double WeightVector __attribute__((vector_size(MANIFEST_LANES * sizeof(double))));
+typedef int64_t LaneMask __attribute__((vector_size(MANIFEST_LANES * sizeof(int64_t))));
+
+// Structure to store the aggregates of a cargo manifest
+typedef struct {
+    uint64_t item_count;
+    double cargo_weight;
+    double min_item_weight;
+    double max_item_weight;
+    uint64_t invalid_items; // not positive or above the per-item limit
+} ManifestSummary;
+
 // Function to initialize the plane
 PlaneDetails initialize_plane() {
     PlaneDetails details;
@@ -98,7 +123,7 @@ PlaneDetails initialize_plane() {
 
 // Function to create passenger processes and get total passenger weight
 double create_passenger_processes(int num_passengers, int pipefd[num_passengers][2]) {
-    int total_passenger_weight = 0;
+    double total_passenger_weight = 0;
 
     // Loop to create each passenger process
     for (int i = 0; i < num_passengers; ++i) {
@@ -201,6 +226,159 @@ double calculate_total_weight_cargo(int num_cargo_items, int avg_cargo_weight) {
     return total_weight;
 }
 
+// Function to calculate the total weight of a cargo plane from its manifest
+double calculate_total_weight_cargo_manifest(const ManifestSummary *summary) {
+    // Calculate total crew weight
+    int total_crew_weight = NUM_CREW_MEMBERS_CARGO * AVG_CREW_WEIGHT;
+
+    // Calculate total weight of the plane
+    double total_weight = summary->cargo_weight + total_crew_weight;
+
+    return total_weight;
+}
+
+// Function to aggregate a weight column. Blocks of MANIFEST_LANES weights are
+// folded into vector accumulators with branch-free selects, and the lanes are
+// combined only once at the end.
+ManifestSummary summarize_manifest(const double *weights, uint64_t item_count, double item_limit) {
+    WeightVector sum = {0};
+    WeightVector min;
+    WeightVector max;
+    LaneMask invalid = {0};
+    uint64_t blocked_count = item_count - item_count % MANIFEST_LANES;
+
+    for (int l = 0; l < MANIFEST_LANES; l++) {
+        min[l] = INFINITY;
+        max[l] = -INFINITY;
+    }
+
+    for (uint64_t i = 0; i < blocked_count; i += MANIFEST_LANES) {
+        WeightVector weight;
+        memcpy(&weight, &weights[i], sizeof(weight));
+
+        LaneMask below_min = weight < min;
+        LaneMask above_max = weight > max;
+        LaneMask valid = (weight > 0) & (weight <= item_limit);
+
+        sum += weight;
+        min = (WeightVector) ((below_min & (LaneMask) weight) | (~below_min & (LaneMask) min));
+        max = (WeightVector) ((above_max & (LaneMask) weight) | (~above_max & (LaneMask) max));
+        invalid += ~valid & 1;
+    }
+
+    ManifestSummary summary = { item_count, 0, min[0], max[0], 0 };
+    for (int l = 0; l < MANIFEST_LANES; l++) {
+        summary.cargo_weight += sum[l];
+        summary.min_item_weight = min[l] < summary.min_item_weight ? min[l] : summary.min_item_weight;
+        summary.max_item_weight = max[l] > summary.max_item_weight ? max[l] : summary.max_item_weight;
+        summary.invalid_items += invalid[l];
+    }
+
+    // Remaining items that do not fill a whole block
+    for (uint64_t i = blocked_count; i < item_count; i++) {
+        double weight = weights[i];
+        summary.cargo_weight += weight;
+        summary.min_item_weight = weight < summary.min_item_weight ? weight : summary.min_item_weight;
+        summary.max_item_weight = weight > summary.max_item_weight ? weight : summary.max_item_weight;
+        summary.invalid_items += !(weight > 0 && weight <= item_limit);
+    }
+
+    return summary;
+}
+
+// Function to memory-map a cargo manifest and aggregate its weights.
+// Returns false if the file cannot be read or is not a valid manifest.
+bool load_cargo_manifest(const char *path, double item_limit, ManifestSummary *summary) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("open");
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        perror("fstat");
+        close(fd);
+        return false;
+    }
+    if ((size_t) st.st_size < sizeof(ManifestHeader)) {
+        printf("Invalid manifest: file too small\n");
+        close(fd);
+        return false;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror("mmap");
+        return false;
+    }
+
+    // Validate the header before touching the weight column
+    const ManifestHeader *header = (const ManifestHeader*) data;
+    bool valid = header->magic == MANIFEST_MAGIC && header->version == MANIFEST_VERSION
+        && header->weights_offset >= sizeof(ManifestHeader)
+        && header->weights_offset % MANIFEST_ALIGNMENT == 0
+        && header->weights_offset <= (uint64_t) st.st_size
+        && header->item_count <= ((uint64_t) st.st_size - header->weights_offset) / sizeof(double);
+    if (!valid) {
+        printf("Invalid manifest: bad header\n");
+        munmap(data, st.st_size);
+        return false;
+    }
+
+    // The column is read once front to back
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    madvise(data, st.st_size, MADV_WILLNEED);
+    const double *weights = (const double*) ((const char*) data + header->weights_offset);
+    *summary = summarize_manifest(weights, header->item_count, item_limit);
+
+    munmap(data, st.st_size);
+    return true;
+}
+
+// Function to prompt for a cargo manifest until a valid one is given.
+// Returns false if the user chooses to enter the cargo details manually.
+bool read_cargo_manifest(ManifestSummary *summary) {
+    char path[MAX_PATH_LENGTH];
+
+    printf("Enter Cargo Manifest File (or - to enter cargo items manually): ");
+    scanf("%255s", path);
+    if (strcmp(path, "-") == 0) {
+        return false;
+    }
+
+    // Prompt for the per-item weight limit the manifest is checked against
+    double item_limit;
+    printf("Enter Maximum Weight of a Cargo Item in kgs: ");
+    scanf("%lf", &item_limit);
+    while (!(item_limit > 0)) {
+        printf("Invalid input. Please enter a positive number: ");
+        scanf("%lf", &item_limit);
+    }
+
+    while (true) {
+        // Validate the per-item limit; the total is checked against the runway at the airport
+        if (load_cargo_manifest(path, item_limit, summary)) {
+            if (summary->item_count == 0) {
+                printf("Invalid manifest: no cargo items\n");
+            } else if (summary->invalid_items > 0) {
+                printf("Invalid manifest: %llu items are outside 0 to %.2f kgs (min %.2f, max %.2f)\n",
+                       (unsigned long long) summary->invalid_items, item_limit,
+                       summary->min_item_weight, summary->max_item_weight);
+            } else {
+                return true;
+            }
+        }
+
+        printf("Enter Cargo Manifest File (or - to enter cargo items manually): ");
+        scanf("%255s", path);
+        if (strcmp(path, "-") == 0) {
+            return false;
+        }
+    }
+}
+
 // Function to send plane details to air traffic controller
 void send_plane_details(int msgqid, PlaneDetails details) {
     // Create a message
@@ -221,6 +399,10 @@ void receive_confirmation(int msgqid, PlaneDetails details) {
     msgrcv(msgqid, &msg, sizeof(Message) - sizeof(long), details.plane_id+10, 0);
 
     // Print the final message
+    if (msg.details.arrival_airport == FLIGHT_REJECTED_AIRPORT) {
+        printf("Plane %d could not travel from Airport %d to Airport %d, an airport rejected the flight\n", details.plane_id, details.departure_airport, details.arrival_airport);
+        return;
+    }
     printf("Plane %d has successfully traveled from Airport %d to Airport %d!\n", msg.details.plane_id, msg.details.departure_airport, msg.details.arrival_airport);
 }
 
@@ -235,7 +417,16 @@ int main() {
     double total_passenger_weight = create_passenger_processes(details.num_passengers, pipefd);
     
         // Perform operations based on plane type
-    if (details.plane_type == 0) {
+    ManifestSummary manifest;
+    if (details.plane_type == 0 && read_cargo_manifest(&manifest)) {
+        // If a cargo manifest was given, take the weight from it
+        details.total_weight = calculate_total_weight_cargo_manifest(&manifest);
+
+        // Display the manifest and the total weight of the cargo plane
+        printf("Cargo Manifest: %llu items, %.2f to %.2f kgs each\n", (unsigned long long) manifest.item_count,
+               manifest.min_item_weight, manifest.max_item_weight);
+        printf("Total Weight of Cargo Plane: %.2f kgs\n", details.total_weight);
+    } else if (details.plane_type == 0) {
         // If the plane is of cargo type, prompt for cargo details
         // Prompt for the number of cargo items
         int num_cargo_items;
@@ -273,7 +464,7 @@ int main() {
     }
 
     // Create message queue
-    key_t key = ftok(".", 'g'); // Generate a unique key for the message queue
+    key_t key = get_ipc_key('g'); // Generate a unique key for the message queue
     int msgqid = msgget(key, 0666 | IPC_CREAT); // Create a message queue with read-write permissions
     
     